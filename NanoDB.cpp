@@ -1,8 +1,15 @@
 #include "NanoDB.h"
 
+#if NANODB_HAS_MMAP
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <fcntl.h>
+  #include <unistd.h>
+#endif
+
 // ---------------- NanoRecord ----------------
 
-NanoRecord::NanoRecord() : _cols(nullptr), _colCount(0), _rowSize(0), _data(nullptr) {}
+NanoRecord::NanoRecord() : _cols(nullptr), _colCount(0), _rowSize(0), _data(nullptr), _view(false), _dirty(0) {}
 NanoRecord::~NanoRecord() { detach(); }
 
 void NanoRecord::attach(const ColumnDef *cols, uint8_t colCount, uint16_t rowSize) {
@@ -12,13 +19,24 @@ void NanoRecord::attach(const ColumnDef *cols, uint8_t colCount, uint16_t rowSiz
   _rowSize = rowSize;
   _data = (uint8_t*)malloc(_rowSize);
   if (_data) memset(_data, 0, _rowSize);
+  _dirty = 0;
+}
+
+void NanoRecord::attachView(const ColumnDef *cols, uint8_t colCount, uint16_t rowSize, const uint8_t *row) {
+  detach();
+  _cols = cols;
+  _colCount = colCount;
+  _rowSize = rowSize;
+  _data = const_cast<uint8_t*>(row); // never written: setters reject views
+  _view = true;
+  _dirty = 0;
 }
 
 void NanoRecord::detach() {
-  if (_data) {
-    free(_data);
-    _data = nullptr;
-  }
+  if (_data && !_view) free(_data);
+  _data = nullptr;
+  _view = false;
+  _dirty = 0;
   _cols = nullptr;
   _colCount = 0;
   _rowSize = 0;
@@ -96,26 +114,91 @@ const char* NanoRecord::getCString(const String &colName) const { int i = colInd
 
 // setters by index
 void NanoRecord::setInt(uint8_t idx, int32_t v) {
-  if (!_data || idx >= _colCount) return;
+  if (!_data || _view || idx >= _colCount) return;
   memcpy(_data + offsetOf(idx), &v, 4);
+  _dirty |= (uint16_t)(1u << idx);
 }
 void NanoRecord::setFloat(uint8_t idx, float v) {
-  if (!_data || idx >= _colCount) return;
+  if (!_data || _view || idx >= _colCount) return;
   memcpy(_data + offsetOf(idx), &v, 4);
+  _dirty |= (uint16_t)(1u << idx);
 }
 void NanoRecord::setBool(uint8_t idx, bool v) {
-  if (!_data || idx >= _colCount) return;
+  if (!_data || _view || idx >= _colCount) return;
   _data[offsetOf(idx)] = v ? 1 : 0;
+  _dirty |= (uint16_t)(1u << idx);
 }
 void NanoRecord::setString(uint8_t idx, const String &s) {
-  if (!_data || idx >= _colCount) return;
+  if (!_data || _view || idx >= _colCount) return;
   size_t maxlen = _cols[idx].size;
   size_t copylen = min((size_t)maxlen, (size_t)s.length());
   // zero pad full field
   memset(_data + offsetOf(idx), 0, maxlen);
   if (copylen) memcpy(_data + offsetOf(idx), s.c_str(), copylen);
+  _dirty |= (uint16_t)(1u << idx);
+}
+
+// ---------------- Instrumentation ----------------
+
+#if NANODB_STATS
+NanoOpScope::NanoOpScope(NanoStats &stats, uint8_t &curOp, uint8_t op)
+  : _stats(stats), _curOp(curOp), _outer(curOp == NANO_OP_OTHER), _start(0) {
+  if (_outer) {
+    _curOp = op;
+    _start = micros();
+  }
+}
+
+NanoOpScope::~NanoOpScope() {
+  if (!_outer) return;
+  if (_curOp < NANO_OP_TIMED) {
+    uint32_t us = micros() - _start;
+    uint8_t b = 0;
+    while (us > 1 && b < NANO_LAT_BUCKETS - 1) { us >>= 1; b++; }
+    _stats.latency[_curOp][b]++;
+  }
+  _curOp = NANO_OP_OTHER;
 }
 
+static const char* const NANO_OP_NAMES[NANO_OP_COUNT] = {
+  "read", "save", "update", "find", "drop", "other"
+};
+
+void NanoTable::resetStats() {
+  memset(&_stats, 0, sizeof(_stats));
+}
+
+void NanoTable::dumpStats(Print &out) const {
+  // io <op> o=<opens> s=<seeks> r=<reads> w=<writes> rb=<bytes read> wb=<bytes written>
+  for (int i=0;i<NANO_OP_COUNT;i++) {
+    const NanoIoStats &io = _stats.io[i];
+    if (!io.opens && !io.seeks && !io.reads && !io.writes) continue;
+    out.print("io "); out.print(NANO_OP_NAMES[i]);
+    out.print(" o="); out.print(io.opens);
+    out.print(" s="); out.print(io.seeks);
+    out.print(" r="); out.print(io.reads);
+    out.print(" w="); out.print(io.writes);
+    out.print(" rb="); out.print(io.bytesRead);
+    out.print(" wb="); out.println(io.bytesWritten);
+  }
+  // scan n=<scans> rows=<rows examined> last=<rows in last scan> alloc=<record allocations>
+  out.print("scan n="); out.print(_stats.scans);
+  out.print(" rows="); out.print(_stats.rowsExamined);
+  out.print(" last="); out.print(_stats.lastScanRows);
+  out.print(" alloc="); out.println(_stats.recordAllocs);
+  // lat <op> <bucket>:<count> ...   (bucket b = [2^b, 2^(b+1)) us)
+  for (int i=0;i<NANO_OP_TIMED;i++) {
+    bool any = false;
+    for (int b=0;b<NANO_LAT_BUCKETS;b++) {
+      if (!_stats.latency[i][b]) continue;
+      if (!any) { out.print("lat "); out.print(NANO_OP_NAMES[i]); any = true; }
+      out.print(' '); out.print(b); out.print(':'); out.print(_stats.latency[i][b]);
+    }
+    if (any) out.println();
+  }
+}
+#endif
+
 // ---------------- NanoTable ----------------
 
 NanoTable::NanoTable(const String &tableName) {
@@ -123,6 +206,548 @@ NanoTable::NanoTable(const String &tableName) {
   _path = "/" + tableName + ".tbl";
   _colCount = 0;
   _recordSize = 0;
+  _map = nullptr;
+  _mapLen = 0;
+  _sortMem = NANO_SORT_MEM;
+  _sortSeq = 0;
+#if NANODB_STATS
+  memset(&_stats, 0, sizeof(_stats));
+  _statOp = NANO_OP_OTHER;
+#endif
+}
+
+NanoTable::~NanoTable() {
+  unmap();
+}
+
+File NanoTable::_open(const String &path, const char *mode) {
+  NANO_STAT(_stats.io[_statOp].opens++);
+  return NANOFS.open(path, mode);
+}
+
+bool NanoTable::_seek(File &f, size_t offset) {
+  NANO_STAT(_stats.io[_statOp].seeks++);
+  return f.seek(offset);
+}
+
+size_t NanoTable::_read(File &f, uint8_t *buf, size_t len) {
+  size_t n = f.read(buf, len);
+  NANO_STAT(_stats.io[_statOp].reads++; _stats.io[_statOp].bytesRead += n);
+  return n;
+}
+
+size_t NanoTable::_write(File &f, const uint8_t *buf, size_t len) {
+  size_t n = f.write(buf, len);
+  NANO_STAT(_stats.io[_statOp].writes++; _stats.io[_statOp].bytesWritten += n);
+  return n;
+}
+
+bool NanoTable::_openScan(File &f) {
+  if (_map) return true; // scans read straight from the mapping
+  f = _open(_path, "r");
+  return (bool)f;
+}
+
+size_t NanoTable::_scanEnd(File &f) {
+  return _map ? _mapLen : (size_t)f.size();
+}
+
+const uint8_t* NanoTable::_fetch(File &f, size_t offset, uint8_t *buf, size_t len) {
+  if (_map) return (offset + len <= _mapLen) ? _map + offset : nullptr;
+  _seek(f, offset);
+  return (_read(f, buf, len) == len) ? buf : nullptr;
+}
+
+bool NanoTable::_readAt(File &f, size_t offset, uint8_t *dst, size_t len) {
+  if (_map) {
+    if (offset + len > _mapLen) return false;
+    memcpy(dst, _map + offset, len);
+    return true;
+  }
+  _seek(f, offset);
+  return _read(f, dst, len) == len;
+}
+
+// fixed-size string field (zero padded) equals val
+static bool nanoFieldEquals(const uint8_t *field, size_t size, const String &val) {
+  size_t n = val.length();
+  if (n > size) return false;
+  if (n && memcmp(field, val.c_str(), n) != 0) return false;
+  return n == size || field[n] == 0;
+}
+
+// ---------------- Export / import ----------------
+
+static const uint8_t NANO_DUMP_MAGIC[4] = { 'N', 'D', 'B', '1' };
+
+// chainable CRC-32 (IEEE): nanoCrc32(nanoCrc32(0, a, n), b, m) == crc of a+b
+static uint32_t nanoCrc32(uint32_t crc, const uint8_t *p, size_t len) {
+  crc = ~crc;
+  while (len--) {
+    crc ^= *p++;
+    for (int k=0;k<8;k++) crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1)));
+  }
+  return ~crc;
+}
+
+// false on a short write (the Print stopped accepting bytes)
+static bool nanoWrite(Print &out, const void *p, size_t len) {
+  return out.write((const uint8_t*)p, len) == len;
+}
+
+static bool nanoCsvRow(Print &out, const NanoRecord &row) {
+  // every print below emits at least one byte, so 0 means the output is gone
+  bool ok = true;
+  for (int i=0;i<row.columnCount() && ok;i++) {
+    if (i) ok = out.print(',') > 0;
+    switch (row.columns()[i].type) {
+      case 'I': ok = ok && out.print((long)row.getInt(i)) > 0; break;
+      case 'F': ok = ok && out.print(row.getFloat(i), 6) > 0; break;
+      case 'B': ok = ok && out.print(row.getBool(i) ? '1' : '0') > 0; break;
+      case 'S': {
+        ok = ok && out.print('"') > 0;
+        for (const char *c = row.getCString(i); *c && ok; c++) {
+          if (*c == '"') ok = out.print('"') > 0;
+          ok = ok && out.print(*c) > 0;
+        }
+        ok = ok && out.print('"') > 0;
+        break;
+      }
+      default: break;
+    }
+  }
+  return ok && out.println() > 0;
+}
+
+uint32_t NanoTable::exportTo(Print &out, NanoFormat fmt) {
+  if (_colCount==0 && !_loadHeader()) return 0;
+  if (_recordSize == 0) return 0;
+  int idIdx = -1;
+  for (int i=0;i<_colCount;i++) if (_cols[i].name=="id" && _cols[i].type=='I') { idIdx=i; break; }
+  size_t idOff = 0;
+  for (int j=0;j<idIdx;j++) idOff += _typeSize(_cols[j]);
+
+  uint16_t perChunk = max(1, NANO_IO_CHUNK / (int)_recordSize);
+  uint8_t *buf = (uint8_t*)malloc((size_t)perChunk * _recordSize);
+  if (!buf) return 0;
+  File f;
+  if (!_openScan(f)) { free(buf); return 0; }
+
+  bool ok = true;
+  if (fmt == NANO_FMT_BINARY) {
+    // magic + schema in the same layout as the table file header
+    ok = nanoWrite(out, NANO_DUMP_MAGIC, 4);
+    uint8_t cc = _colCount;
+    ok = ok && nanoWrite(out, &cc, 1);
+    for (int i=0;i<_colCount && ok;i++) {
+      uint8_t nl = (uint8_t)min((size_t)255, _cols[i].name.length());
+      ok = nanoWrite(out, &nl, 1)
+        && nanoWrite(out, _cols[i].name.c_str(), nl)
+        && nanoWrite(out, &_cols[i].type, 1)
+        && nanoWrite(out, &_cols[i].size, 2);
+    }
+  } else {
+    for (int i=0;i<_colCount && ok;i++) {
+      if (i) ok = out.print(',') > 0;
+      ok = ok && out.print(_cols[i].name) == _cols[i].name.length();
+    }
+    ok = ok && out.println() > 0;
+  }
+  if (!ok) { f.close(); free(buf); return 0; }
+
+  // rows counts only what the output fully accepted: whole chunks (binary) or lines (CSV)
+  uint32_t rows = 0;
+  size_t pos = _headerSizeBytes();
+  size_t end = _scanEnd(f);
+  NANO_SCAN_SCOPE();
+  while (pos + _recordSize <= end) {
+    uint16_t n = (uint16_t)min((size_t)perChunk, (end - pos) / _recordSize);
+    if (!_readAt(f, pos, buf, (size_t)n * _recordSize)) break;
+    pos += (size_t)n * _recordSize;
+    NANO_STAT(_stats.rowsExamined += n);
+    // compact live rows (id != 0) to the front of the chunk
+    uint16_t live = 0;
+    for (uint16_t i=0;i<n;i++) {
+      uint8_t *row = buf + (size_t)i * _recordSize;
+      if (idIdx >= 0) {
+        int32_t v; memcpy(&v, row + idOff, 4);
+        if (v == 0) continue;
+      }
+      if (live != i) memmove(buf + (size_t)live * _recordSize, row, _recordSize);
+      live++;
+    }
+    if (!live) continue;
+    if (fmt == NANO_FMT_BINARY) {
+      size_t len = (size_t)live * _recordSize;
+      uint32_t crc = nanoCrc32(nanoCrc32(0, (const uint8_t*)&live, 2), buf, len);
+      if (!nanoWrite(out, &live, 2) || !nanoWrite(out, buf, len) || !nanoWrite(out, &crc, 4)) { ok = false; break; }
+      rows += live;
+    } else {
+      NanoRecord row;
+      for (uint16_t i=0;i<live && ok;i++) {
+        row.attachView(_cols, _colCount, _recordSize, buf + (size_t)i * _recordSize);
+        ok = nanoCsvRow(out, row);
+        if (ok) rows++;
+      }
+      if (!ok) break;
+    }
+  }
+  if (fmt == NANO_FMT_BINARY && ok) {
+    // without the terminator the dump can't be restored, so nothing counts as exported
+    uint16_t zero = 0;
+    if (!nanoWrite(out, &zero, 2)) rows = 0;
+  }
+  f.close();
+  free(buf);
+  return rows;
+}
+
+uint32_t NanoTable::importFrom(Stream &in, uint32_t skip) {
+  if (_colCount==0 && !_loadHeader()) return 0;
+  if (_recordSize == 0) return 0;
+  uint8_t magic[4];
+  if (in.readBytes(magic, 4) != 4 || memcmp(magic, NANO_DUMP_MAGIC, 4) != 0) return 0;
+  // schema must match the table exactly
+  uint8_t cc;
+  if (in.readBytes(&cc, 1) != 1 || cc != _colCount) return 0;
+  for (int i=0;i<_colCount;i++) {
+    uint8_t nl;
+    char nb[256];
+    char t;
+    uint16_t sz;
+    if (in.readBytes(&nl, 1) != 1) return 0;
+    if (nl > 0 && in.readBytes((uint8_t*)nb, nl) != nl) return 0;
+    nb[nl] = 0;
+    if (in.readBytes((uint8_t*)&t, 1) != 1 || in.readBytes((uint8_t*)&sz, 2) != 2) return 0;
+    if (_cols[i].name != String(nb) || _cols[i].type != t) return 0;
+    if (t == 'S' && _cols[i].size != sz) return 0; // size only matters for strings
+  }
+
+  int idIdx = -1;
+  for (int i=0;i<_colCount;i++) if (_cols[i].name=="id" && _cols[i].type=='I') { idIdx=i; break; }
+  size_t idOff = 0;
+  for (int j=0;j<idIdx;j++) idOff += _typeSize(_cols[j]);
+  int32_t maxId = (idIdx >= 0) ? _nextId() - 1 : 0; // the only scan: ids are tracked from here on
+
+  uint16_t perChunk = max(1, NANO_IO_CHUNK / (int)_recordSize);
+  uint8_t *buf = (uint8_t*)malloc((size_t)perChunk * _recordSize);
+  if (!buf) return 0;
+  File f = _open(_path, "a");
+  if (!f) { free(buf); return 0; }
+
+  uint32_t rows = 0; // rows appended by this call
+  for (;;) {
+    uint16_t n;
+    if (in.readBytes((uint8_t*)&n, 2) != 2) break;
+    if (n == 0) break;
+    if (n > perChunk) break; // written with a larger NANO_IO_CHUNK
+    size_t len = (size_t)n * _recordSize;
+    uint32_t crc;
+    if (in.readBytes(buf, len) != len) break;
+    if (in.readBytes((uint8_t*)&crc, 4) != 4) break;
+    if (crc != nanoCrc32(nanoCrc32(0, (const uint8_t*)&n, 2), buf, len)) break;
+    // rows a previous, interrupted import already appended
+    if (skip) {
+      uint16_t drop = (uint16_t)min((uint32_t)n, skip);
+      skip -= drop;
+      n -= drop;
+      len = (size_t)n * _recordSize;
+      if (!n) continue;
+      memmove(buf, buf + (size_t)drop * _recordSize, len);
+    }
+    if (idIdx >= 0) {
+      for (uint16_t i=0;i<n;i++) {
+        uint8_t *idp = buf + (size_t)i * _recordSize + idOff;
+        int32_t v; memcpy(&v, idp, 4);
+        if (v <= maxId) { v = maxId + 1; memcpy(idp, &v, 4); }
+        maxId = v;
+      }
+    }
+    // whole chunk in one append
+    if (_write(f, buf, len) != len) break;
+    rows += n;
+  }
+  f.close();
+  free(buf);
+  if (_map) map();
+  return rows;
+}
+
+// ---------------- Sorting ----------------
+
+// Sort entries are the key column's raw bytes followed by the row's uint32 file
+// offset; ties fall back to the offset, so equal keys keep file order.
+struct NanoSortKey {
+  char type;
+  uint16_t size;
+  bool asc;
+
+  int compare(const uint8_t *a, const uint8_t *b) const {
+    int c = 0;
+    switch (type) {
+      case 'I': { int32_t x, y; memcpy(&x, a, 4); memcpy(&y, b, 4); c = (x > y) - (x < y); break; }
+      case 'F': { float x, y; memcpy(&x, a, 4); memcpy(&y, b, 4); c = (x > y) - (x < y); break; }
+      default: c = memcmp(a, b, size); break; // 'B', and 'S' (zero padded)
+    }
+    if (!asc) c = -c;
+    if (c) return c;
+    uint32_t oa, ob;
+    memcpy(&oa, a + size, 4);
+    memcpy(&ob, b + size, 4);
+    return (oa > ob) - (oa < ob);
+  }
+};
+
+static void nanoSwap(uint8_t *a, uint8_t *b, uint16_t n) {
+  while (n--) { uint8_t t = *a; *a++ = *b; *b++ = t; }
+}
+
+// max-heap on key.compare (largest = last in sort order at the root)
+static void nanoSiftDown(uint8_t *e, uint32_t n, uint32_t i, uint16_t es, const NanoSortKey &key) {
+  for (;;) {
+    uint32_t l = 2*i + 1, m = i;
+    if (l < n && key.compare(e + (size_t)l*es, e + (size_t)m*es) > 0) m = l;
+    if (l + 1 < n && key.compare(e + (size_t)(l+1)*es, e + (size_t)m*es) > 0) m = l + 1;
+    if (m == i) return;
+    nanoSwap(e + (size_t)i*es, e + (size_t)m*es, es);
+    i = m;
+  }
+}
+
+static void nanoSiftUp(uint8_t *e, uint32_t i, uint16_t es, const NanoSortKey &key) {
+  while (i > 0) {
+    uint32_t p = (i - 1) / 2;
+    if (key.compare(e + (size_t)i*es, e + (size_t)p*es) <= 0) return;
+    nanoSwap(e + (size_t)i*es, e + (size_t)p*es, es);
+    i = p;
+  }
+}
+
+// in-place heapsort of a heap or an unordered array (heapify == true)
+static void nanoHeapSort(uint8_t *e, uint32_t n, uint16_t es, const NanoSortKey &key, bool heapify) {
+  if (heapify) for (uint32_t i = n/2; i-- > 0;) nanoSiftDown(e, n, i, es, key);
+  while (n > 1) {
+    n--;
+    nanoSwap(e, e + (size_t)n*es, es);
+    nanoSiftDown(e, n, 0, es, key);
+  }
+}
+
+// runs are named per sort so cursors from earlier orderBy() calls keep their files
+String NanoTable::_runPath(uint32_t sort, uint32_t run) const {
+  return "/" + _name + ".s" + String(sort) + "_" + String(run) + ".tmp";
+}
+
+bool NanoTable::_spillRun(uint8_t *entries, uint32_t n, uint16_t entrySize, uint32_t sort, uint32_t run) {
+  File f = _open(_runPath(sort, run), "w");
+  if (!f) return false;
+  size_t len = (size_t)n * entrySize;
+  bool ok = _write(f, entries, len) == len;
+  f.close();
+  return ok;
+}
+
+// k-way merge of runs [first, first+count) into run `out`; inputs are always
+// removed, and so is `out` when the merge fails
+bool NanoTable::_mergeRuns(uint32_t sort, uint32_t first, uint32_t count, uint32_t out, uint16_t entrySize, const NanoSortKey &key) {
+  File in[NANO_SORT_FANIN];
+  uint32_t left[NANO_SORT_FANIN]; // entries not yet consumed, incl. the current head
+  uint8_t *heads = (uint8_t*)malloc((size_t)count * entrySize);
+  if (!heads) return false;
+  File o = _open(_runPath(sort, out), "w");
+  bool ok = (bool)o;
+  for (uint32_t i=0;i<count && ok;i++) {
+    in[i] = _open(_runPath(sort, first + i), "r");
+    if (!in[i] || in[i].size() % entrySize != 0) { ok = false; break; }
+    // run length comes from the file size, so a short read is an error, not the end
+    left[i] = in[i].size() / entrySize;
+    if (left[i] && _read(in[i], heads + (size_t)i*entrySize, entrySize) != entrySize) ok = false;
+  }
+  while (ok) {
+    int best = -1;
+    for (uint32_t i=0;i<count;i++) {
+      if (!left[i]) continue;
+      if (best < 0 || key.compare(heads + (size_t)i*entrySize, heads + (size_t)best*entrySize) < 0) best = i;
+    }
+    if (best < 0) break;
+    uint8_t *h = heads + (size_t)best*entrySize;
+    if (_write(o, h, entrySize) != entrySize) { ok = false; break; }
+    if (--left[best] && _read(in[best], h, entrySize) != entrySize) { ok = false; break; }
+  }
+  for (uint32_t i=0;i<count;i++) {
+    if (in[i]) in[i].close();
+    NANOFS.remove(_runPath(sort, first + i));
+  }
+  if (o) o.close();
+  if (!ok) NANOFS.remove(_runPath(sort, out));
+  free(heads);
+  return ok;
+}
+
+bool NanoTable::orderBy(NanoCursor &cur, const String &col, bool asc, uint32_t limit) {
+  NANO_OP_SCOPE(NANO_OP_FIND);
+  cur.close();
+  if (_colCount==0 && !_loadHeader()) return false;
+  int idx = -1;
+  for (int i=0;i<_colCount;i++) if (_cols[i].name==col) { idx=i; break; }
+  if (idx < 0) return false;
+  int idIdx = -1;
+  for (int i=0;i<_colCount;i++) if (_cols[i].name=="id" && _cols[i].type=='I') { idIdx=i; break; }
+  size_t keyOff = 0, idOff = 0;
+  for (int j=0;j<idx;j++) keyOff += _typeSize(_cols[j]);
+  for (int j=0;j<idIdx;j++) idOff += _typeSize(_cols[j]);
+
+  NanoSortKey key = { _cols[idx].type, _typeSize(_cols[idx]), asc };
+  uint16_t entrySize = key.size + 4;
+  uint32_t cap = _sortMem / entrySize;
+  if (cap < 2) cap = 2;
+  bool topK = limit > 0 && limit <= cap;
+  if (topK) cap = limit;
+
+  // top-K keeps one spare slot to stage the candidate entry
+  uint8_t *entries = (uint8_t*)malloc((size_t)(topK ? cap + 1 : cap) * entrySize);
+  uint8_t *row = (uint8_t*)malloc(_recordSize);
+  File f;
+  if (!entries || !row || !_openScan(f)) { free(entries); free(row); return false; }
+
+  uint32_t n = 0;       // entries in the buffer
+  uint32_t runs = 0;    // runs spilled so far
+  uint32_t sort = _sortSeq++;
+  bool ok = true;
+  size_t pos = _headerSizeBytes();
+  size_t end = _scanEnd(f);
+  {
+    NANO_SCAN_SCOPE();
+    while (pos + _recordSize <= end) {
+      NANO_STAT(_stats.rowsExamined++);
+      if (!_readAt(f, pos, row, _recordSize)) break;
+      uint32_t off = (uint32_t)pos;
+      pos += _recordSize;
+      if (idIdx >= 0) {
+        int32_t v; memcpy(&v, row + idOff, 4);
+        if (v == 0) continue; // deleted
+      }
+      if (!topK && n == cap) {
+        nanoHeapSort(entries, n, entrySize, key, true);
+        if (!_spillRun(entries, n, entrySize, sort, runs++)) { ok = false; break; }
+        n = 0;
+      }
+      uint8_t *e = entries + (size_t)n * entrySize; // spare slot once a top-K heap is full
+      memcpy(e, row + keyOff, key.size);
+      memcpy(e + key.size, &off, 4);
+      if (!topK) {
+        n++;
+      } else if (n < cap) {
+        nanoSiftUp(entries, n++, entrySize, key);
+      } else if (key.compare(e, entries) < 0) {
+        // sorts before the current worst (root): replace it
+        memcpy(entries, e, entrySize);
+        nanoSiftDown(entries, n, 0, entrySize, key);
+      }
+    }
+  }
+  free(row);
+  f.close();
+  if (!ok) for (uint32_t r=0;r<runs;r++) NANOFS.remove(_runPath(sort, r));
+
+  if (ok) {
+    nanoHeapSort(entries, n, entrySize, key, !topK);
+    if (runs > 0) {
+      // spill the tail and merge NANO_SORT_FANIN runs at a time until one is left
+      if (n && !_spillRun(entries, n, entrySize, sort, runs++)) ok = false;
+      free(entries);
+      entries = nullptr;
+      uint32_t lo = 0, hi = runs;
+      while (ok && hi - lo > 1) {
+        uint32_t k = min((uint32_t)NANO_SORT_FANIN, hi - lo);
+        ok = _mergeRuns(sort, lo, k, hi, entrySize, key); // on failure removes its inputs and output
+        lo += k;
+        if (ok) hi++;
+      }
+      if (ok) {
+        cur._runPath = _runPath(sort, lo);
+        cur._run = _open(cur._runPath, "r");
+        ok = (bool)cur._run;
+        if (ok) n = cur._run.size() / entrySize;
+      }
+      if (!ok) for (uint32_t r = lo; r < hi; r++) NANOFS.remove(_runPath(sort, r));
+    }
+  }
+  if (ok && !_openScan(cur._data)) ok = false;
+  if (!ok) {
+    free(entries);
+    cur.close();
+    return false;
+  }
+
+  cur._table = this;
+  cur._buf = entries;
+  cur._count = n;
+  cur._pos = 0;
+  cur._left = (limit > 0 && limit < n) ? limit : n;
+  cur._entrySize = entrySize;
+  cur._keySize = key.size;
+  return true;
+}
+
+// ---------------- NanoCursor ----------------
+
+NanoCursor::NanoCursor()
+  : _table(nullptr), _buf(nullptr), _count(0), _pos(0), _left(0), _entrySize(0), _keySize(0) {}
+
+NanoCursor::~NanoCursor() { close(); }
+
+void NanoCursor::close() {
+  if (_buf) { free(_buf); _buf = nullptr; }
+  if (_run) _run.close();
+  if (_runPath.length()) { NANOFS.remove(_runPath); _runPath = String(); }
+  if (_data) _data.close();
+  _table = nullptr;
+  _count = _pos = _left = 0;
+}
+
+bool NanoCursor::next(NanoRecord &outRec) {
+  if (!_table || _left == 0 || _pos >= _count) return false;
+  uint32_t off;
+  if (_buf) {
+    memcpy(&off, _buf + (size_t)_pos * _entrySize + _keySize, 4);
+  } else {
+    _table->_seek(_run, (size_t)_pos * _entrySize + _keySize);
+    if (_table->_read(_run, (uint8_t*)&off, 4) != 4) return false;
+  }
+  _pos++;
+  _left--;
+  return _table->_readRecordAt(_data, off, outRec);
+}
+
+// ---------------- Memory mapping ----------------
+
+bool NanoTable::map() {
+#if NANODB_HAS_MMAP
+  unmap();
+  if (_colCount==0 && !_loadHeader()) return false;
+  String full = String(NANODB_MMAP_ROOT) + _path;
+  int fd = ::open(full.c_str(), O_RDONLY);
+  if (fd < 0) return false;
+  struct stat st;
+  if (fstat(fd, &st) != 0 || st.st_size <= 0) { ::close(fd); return false; }
+  void *p = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  ::close(fd); // the mapping keeps its own reference
+  if (p == MAP_FAILED) return false;
+  _map = (const uint8_t*)p;
+  _mapLen = (size_t)st.st_size;
+  return true;
+#else
+  return false;
+#endif
+}
+
+void NanoTable::unmap() {
+#if NANODB_HAS_MMAP
+  if (_map) munmap((void*)_map, _mapLen);
+#endif
+  _map = nullptr;
+  _mapLen = 0;
 }
 
 bool NanoTable::_exists() const {
@@ -153,18 +778,18 @@ size_t NanoTable::_headerSizeBytes() const {
 }
 
 bool NanoTable::_writeHeader(const ColumnDef *cols, uint8_t colCount) {
-  File f = NANOFS.open(_path, "w");
+  File f = _open(_path, "w");
   if (!f) return false;
   uint8_t cc = colCount;
-  f.write(&cc,1);
+  _write(f, &cc,1);
   for (int i=0;i<colCount;i++) {
     String nm = cols[i].name;
     uint8_t nl = (uint8_t)min((size_t)255, nm.length());
-    f.write(&nl,1);
-    f.write((const uint8_t*)nm.c_str(), nl);
-    f.write((uint8_t*)&cols[i].type,1);
+    _write(f, &nl,1);
+    _write(f, (const uint8_t*)nm.c_str(), nl);
+    _write(f, (uint8_t*)&cols[i].type,1);
     uint16_t s = cols[i].size;
-    f.write((const uint8_t*)&s,2);
+    _write(f, (const uint8_t*)&s,2);
   }
   f.close();
   // load header into memory
@@ -172,19 +797,19 @@ bool NanoTable::_writeHeader(const ColumnDef *cols, uint8_t colCount) {
 }
 
 bool NanoTable::_loadHeader() {
-  File f = NANOFS.open(_path,"r");
+  File f = _open(_path, "r");
   if (!f) return false;
   uint8_t cc;
-  if (f.read(&cc,1) != 1) { f.close(); return false; }
+  if (_read(f, &cc,1) != 1) { f.close(); return false; }
   _colCount = cc;
   for (int i=0;i<_colCount;i++) {
     uint8_t nl;
-    f.read(&nl,1);
+    _read(f, &nl,1);
     char nb[256];
-    if (nl > 0) f.read((uint8_t*)nb, nl);
+    if (nl > 0) _read(f, (uint8_t*)nb, nl);
     nb[nl]=0;
-    char t; f.read((uint8_t*)&t,1);
-    uint16_t s; f.read((uint8_t*)&s,2);
+    char t; _read(f, (uint8_t*)&t,1);
+    uint16_t s; _read(f, (uint8_t*)&s,2);
     _cols[i].name = String(nb);
     _cols[i].type = t;
     _cols[i].size = s;
@@ -206,6 +831,8 @@ bool NanoTable::begin(const ColumnDef *cols, uint8_t colCount) {
 }
 
 bool NanoTable::drop() {
+  NANO_OP_SCOPE(NANO_OP_DROP);
+  unmap();
   if (_exists()) return NANOFS.remove(_path);
   return true;
 }
@@ -213,12 +840,15 @@ bool NanoTable::drop() {
 uint32_t NanoTable::records() {
   if (!_exists()) return 0;
   if (_colCount==0) _loadHeader();
-  File f = NANOFS.open(_path,"r");
-  if (!f) return 0;
+  File f;
+  if (!_openScan(f)) return 0;
   size_t hs = _headerSizeBytes();
   size_t pos = hs;
   uint32_t cnt = 0;
-  while (pos + _recordSize <= f.size()) {
+  size_t end = _scanEnd(f);
+  NANO_SCAN_SCOPE();
+  while (pos + _recordSize <= end) {
+    NANO_STAT(_stats.rowsExamined++);
     // check id != 0 if id exists
     int idIdx = -1;
     for (int i=0;i<_colCount;i++) if (_cols[i].name=="id" && _cols[i].type=='I') { idIdx=i; break; }
@@ -227,8 +857,8 @@ uint32_t NanoTable::records() {
     } else {
       size_t idOff = pos + 0;
       for (int j=0;j<idIdx;j++) idOff += _typeSize(_cols[j]);
-      int32_t v; f.seek(idOff);
-      if (f.read((uint8_t*)&v,4)==4 && v != 0) cnt++;
+      int32_t v;
+      if (_readAt(f, idOff, (uint8_t*)&v, 4) && v != 0) cnt++;
     }
     pos += _recordSize;
   }
@@ -246,20 +876,22 @@ uint32_t NanoTable::lastId() {
   }
   if (idIdx < 0) return 0; // no id column
 
-  File f = NANOFS.open(_path, "r");
-  if (!f) return 0;
+  File f;
+  if (!_openScan(f)) return 0;
 
   size_t pos = _headerSizeBytes();
   int32_t maxId = 0;
 
-  while (pos + _recordSize <= f.size()) {
+  size_t end = _scanEnd(f);
+  NANO_SCAN_SCOPE();
+  while (pos + _recordSize <= end) {
+    NANO_STAT(_stats.rowsExamined++);
     // compute offset of id within this record
     size_t idOff = pos;
     for (int j = 0; j < idIdx; j++) idOff += _typeSize(_cols[j]);
 
     int32_t v = 0;
-    f.seek(idOff);
-    if (f.read((uint8_t*)&v, sizeof(v)) != sizeof(v)) break;
+    if (!_readAt(f, idOff, (uint8_t*)&v, 4)) break;
 
     if (v > maxId) maxId = v;
     pos += _recordSize;
@@ -271,7 +903,7 @@ uint32_t NanoTable::lastId() {
 
 size_t NanoTable::size() {
   if (!_exists()) return 0;
-  File f = NANOFS.open(_path,"r");
+  File f = _open(_path, "r");
   if (!f) return 0;
   size_t s = f.size();
   f.close();
@@ -281,6 +913,7 @@ size_t NanoTable::size() {
 bool NanoTable::newRecord(NanoRecord &rec) {
   if (_colCount==0 && !_loadHeader()) return false;
   rec.attach(_cols, _colCount, _recordSize);
+  NANO_STAT(_stats.recordAllocs++);
   return true;
 }
 
@@ -289,16 +922,18 @@ int32_t NanoTable::_nextId() {
   int idIdx = -1;
   for (int i=0;i<_colCount;i++) if (_cols[i].name=="id" && _cols[i].type=='I') { idIdx=i; break; }
   if (idIdx < 0) return 1;
-  File f = NANOFS.open(_path,"r");
-  if (!f) return 1;
+  File f;
+  if (!_openScan(f)) return 1;
   size_t pos = _headerSizeBytes();
   int32_t maxId = 0;
-  while (pos + _recordSize <= f.size()) {
+  size_t end = _scanEnd(f);
+  NANO_SCAN_SCOPE();
+  while (pos + _recordSize <= end) {
+    NANO_STAT(_stats.rowsExamined++);
     size_t idOff = pos;
     for (int j=0;j<idIdx;j++) idOff += _typeSize(_cols[j]);
     int32_t v;
-    f.seek(idOff);
-    if (f.read((uint8_t*)&v,4) != 4) break;
+    if (!_readAt(f, idOff, (uint8_t*)&v, 4)) break;
     if (v > maxId) maxId = v;
     pos += _recordSize;
   }
@@ -308,53 +943,42 @@ int32_t NanoTable::_nextId() {
 
 bool NanoTable::_writeRecordAt(File &f, size_t offset, const NanoRecord &rec) {
   if (!f) return false;
-  if (!rec.columns()) return false;
-  if (offset + _recordSize > (size_t)f.size() && f.position() != offset) {
-    // ensure seek
-    f.seek(offset);
-  } else {
-    f.seek(offset);
-  }
-  // write each field
-  size_t base = f.position();
-  for (int i=0;i<_colCount;i++) {
-    switch (_cols[i].type) {
-      case 'I': {
-        int32_t v = rec.getInt(i);
-        f.write((const uint8_t*)&v, 4);
-        break;
-      }
-      case 'F': {
-        float v = rec.getFloat(i);
-        f.write((const uint8_t*)&v, 4);
-        break;
-      }
-      case 'B': {
-        uint8_t b = rec.getBool(i) ? 1 : 0;
-        f.write(&b, 1);
-        break;
-      }
-      case 'S': {
-        const char* s = rec.getCString(i);
-        size_t len = strlen(s);
-        size_t toWrite = min((size_t)_cols[i].size, len);
-        if (toWrite) f.write((const uint8_t*)s, toWrite);
-        if (_cols[i].size > toWrite) {
-          uint8_t zero = 0;
-          for (size_t z=0; z < (_cols[i].size - toWrite); z++) f.write(&zero,1);
-        }
-        break;
-      }
-      default: break;
+  if (!rec.columns() || !rec.rawData() || rec.rowSize() != _recordSize) return false;
+  // the record buffer already holds the on-disk layout (strings zero padded)
+  _seek(f, offset);
+  return _write(f, rec.rawData(), _recordSize) == _recordSize;
+}
+
+bool NanoTable::_writeDirtyAt(File &f, size_t offset, const NanoRecord &rec) {
+  if (!f) return false;
+  if (!rec.columns() || !rec.rawData() || rec.rowSize() != _recordSize) return false;
+  // one write per run of adjacent dirty columns
+  uint16_t dirty = rec.dirtyMask();
+  const uint8_t *data = rec.rawData();
+  size_t colOff = 0;
+  size_t runStart = 0;
+  bool inRun = false;
+  for (int i=0;i<=_colCount;i++) {
+    bool d = i < _colCount && (dirty & (1u << i));
+    if (d && !inRun) { runStart = colOff; inRun = true; }
+    if (!d && inRun) {
+      size_t len = colOff - runStart;
+      _seek(f, offset + runStart);
+      if (_write(f, data + runStart, len) != len) return false;
+      inRun = false;
     }
+    if (i < _colCount) colOff += _typeSize(_cols[i]);
   }
-  // ensure total bytes written == recordSize (no-op)
   return true;
 }
 
 bool NanoTable::save(NanoRecord &rec) {
+  NANO_OP_SCOPE(NANO_OP_SAVE);
   if (_colCount==0 && !_loadHeader()) return false;
-  if (!rec.columns()) rec.attach(_cols, _colCount, _recordSize);
+  if (!rec.columns()) {
+    rec.attach(_cols, _colCount, _recordSize);
+    NANO_STAT(_stats.recordAllocs++);
+  }
   // set id if exists and zero
   int idIdx = -1;
   for (int i=0;i<_colCount;i++) if (_cols[i].name=="id" && _cols[i].type=='I') { idIdx=i; break; }
@@ -362,48 +986,42 @@ bool NanoTable::save(NanoRecord &rec) {
     int32_t cur = rec.getInt(idIdx);
     if (cur == 0) rec.setInt(idIdx, _nextId());
   }
-  File f = NANOFS.open(_path,"a");
+  File f = _open(_path, "a");
   if (!f) return false;
   bool ok = _writeRecordAt(f, f.size(), rec);
   f.close();
+  if (_map) map(); // the file grew; extend the mapping (invalidates views)
+  if (ok) rec.markClean();
   return ok;
 }
 
 bool NanoTable::_readRecordAt(File &f, size_t offset, NanoRecord &outRec) {
   if (_colCount==0 && !_loadHeader()) return false;
-  if (!outRec.columns()) outRec.attach(_cols, _colCount, _recordSize);
-  if (offset + _recordSize > f.size()) return false;
-  f.seek(offset);
-  // read each field
-  for (int i=0;i<_colCount;i++) {
-    switch (_cols[i].type) {
-      case 'I': {
-        int32_t v; if (f.read((uint8_t*)&v,4) != 4) return false;
-        outRec.setInt(i, v); break;
-      }
-      case 'F': {
-        float v; if (f.read((uint8_t*)&v,4) != 4) return false;
-        outRec.setFloat(i, v); break;
-      }
-      case 'B': {
-        uint8_t b; if (f.read((uint8_t*)&b,1) != 1) return false;
-        outRec.setBool(i, b != 0); break;
-      }
-      case 'S': {
-        uint16_t len = _cols[i].size;
-        char buf[NANO_MAX_STR_LEN];
-        memset(buf,0,sizeof(buf));
-        if (len > 0) {
-          size_t toRead = len;
-          if (toRead > sizeof(buf)-1) toRead = sizeof(buf)-1;
-          if (f.read((uint8_t*)buf, len) != len) return false;
-        }
-        outRec.setString(i, String(buf));
-        break;
-      }
-      default: return false;
-    }
+  // the raw read below needs an owned buffer laid out for this table: views point
+  // into the read-only mapping, and a record from another table has the wrong size
+  if (outRec.columns() != _cols || outRec.rowSize() != _recordSize || outRec.isView()) {
+    outRec.attach(_cols, _colCount, _recordSize);
+    NANO_STAT(_stats.recordAllocs++);
   }
+  if (!outRec.rawData()) return false;
+  // rows are stored exactly as the record buffer lays them out: one read, no per-field copies
+  if (!_readAt(f, offset, outRec.rawData(), _recordSize)) return false;
+  outRec.markClean();
+  return true;
+}
+
+bool NanoTable::_loadAt(size_t offset, NanoRecord &outRec) {
+  File f;
+  if (!_openScan(f)) return false;
+  bool ok = _readRecordAt(f, offset, outRec);
+  f.close();
+  return ok;
+}
+
+bool NanoTable::_viewAt(size_t offset, NanoRecord &outRec) {
+  if (!_map) return _loadAt(offset, outRec);
+  if (offset + _recordSize > _mapLen) return false;
+  outRec.attachView(_cols, _colCount, _recordSize, _map + offset);
   return true;
 }
 
@@ -412,15 +1030,17 @@ size_t NanoTable::_findOffsetById(int32_t idValue) {
   int idIdx = -1;
   for (int i=0;i<_colCount;i++) if (_cols[i].name=="id" && _cols[i].type=='I') { idIdx=i; break; }
   if (idIdx < 0) return SIZE_MAX;
-  File f = NANOFS.open(_path,"r");
-  if (!f) return SIZE_MAX;
+  File f;
+  if (!_openScan(f)) return SIZE_MAX;
   size_t pos = _headerSizeBytes();
-  while (pos + _recordSize <= f.size()) {
+  size_t end = _scanEnd(f);
+  NANO_SCAN_SCOPE();
+  while (pos + _recordSize <= end) {
+    NANO_STAT(_stats.rowsExamined++);
     size_t idOff = pos;
     for (int j=0;j<idIdx;j++) idOff += _typeSize(_cols[j]);
     int32_t v;
-    f.seek(idOff);
-    if (f.read((uint8_t*)&v,4) != 4) break;
+    if (!_readAt(f, idOff, (uint8_t*)&v, 4)) break;
     if (v == idValue) { f.close(); return pos; }
     pos += _recordSize;
   }
@@ -434,17 +1054,22 @@ size_t NanoTable::_findOffsetByColString(const String &col, const String &val) {
   for (int i=0;i<_colCount;i++) if (_cols[i].name==col) { idx=i; break; }
   if (idx < 0) return SIZE_MAX;
   if (_cols[idx].type != 'S') return SIZE_MAX;
-  File f = NANOFS.open(_path,"r");
-  if (!f) return SIZE_MAX;
+  // in-place compare when mapped; otherwise bounded by the stack buffer
+  uint16_t len = _cols[idx].size;
+  if (!_map && len > NANO_MAX_STR_LEN) len = NANO_MAX_STR_LEN;
+  File f;
+  if (!_openScan(f)) return SIZE_MAX;
   size_t pos = _headerSizeBytes();
-  while (pos + _recordSize <= f.size()) {
+  size_t end = _scanEnd(f);
+  NANO_SCAN_SCOPE();
+  while (pos + _recordSize <= end) {
+    NANO_STAT(_stats.rowsExamined++);
     size_t fieldOff = pos;
     for (int j=0;j<idx;j++) fieldOff += _typeSize(_cols[j]);
-    char buf[NANO_MAX_STR_LEN];
-    memset(buf,0,sizeof(buf));
-    f.seek(fieldOff);
-    if (f.read((uint8_t*)buf, _cols[idx].size) != _cols[idx].size) break;
-    if (String(buf) == val) { f.close(); return pos; }
+    uint8_t buf[NANO_MAX_STR_LEN];
+    const uint8_t *field = _fetch(f, fieldOff, buf, len);
+    if (!field) break;
+    if (nanoFieldEquals(field, len, val)) { f.close(); return pos; }
     pos += _recordSize;
   }
   f.close();
@@ -457,15 +1082,17 @@ size_t NanoTable::_findOffsetByColInt(const String &col, int32_t val) {
   for (int i=0;i<_colCount;i++) if (_cols[i].name==col) { idx=i; break; }
   if (idx < 0) return SIZE_MAX;
   if (_cols[idx].type != 'I') return SIZE_MAX;
-  File f = NANOFS.open(_path,"r");
-  if (!f) return SIZE_MAX;
+  File f;
+  if (!_openScan(f)) return SIZE_MAX;
   size_t pos = _headerSizeBytes();
-  while (pos + _recordSize <= f.size()) {
+  size_t end = _scanEnd(f);
+  NANO_SCAN_SCOPE();
+  while (pos + _recordSize <= end) {
+    NANO_STAT(_stats.rowsExamined++);
     size_t fieldOff = pos;
     for (int j=0;j<idx;j++) fieldOff += _typeSize(_cols[j]);
     int32_t v;
-    f.seek(fieldOff);
-    if (f.read((uint8_t*)&v,4) != 4) break;
+    if (!_readAt(f, fieldOff, (uint8_t*)&v, 4)) break;
     if (v == val) { f.close(); return pos; }
     pos += _recordSize;
   }
@@ -479,15 +1106,17 @@ size_t NanoTable::_findOffsetByColFloat(const String &col, float val) {
   for (int i=0;i<_colCount;i++) if (_cols[i].name==col) { idx=i; break; }
   if (idx < 0) return SIZE_MAX;
   if (_cols[idx].type != 'F') return SIZE_MAX;
-  File f = NANOFS.open(_path,"r");
-  if (!f) return SIZE_MAX;
+  File f;
+  if (!_openScan(f)) return SIZE_MAX;
   size_t pos = _headerSizeBytes();
-  while (pos + _recordSize <= f.size()) {
+  size_t end = _scanEnd(f);
+  NANO_SCAN_SCOPE();
+  while (pos + _recordSize <= end) {
+    NANO_STAT(_stats.rowsExamined++);
     size_t fieldOff = pos;
     for (int j=0;j<idx;j++) fieldOff += _typeSize(_cols[j]);
     float v;
-    f.seek(fieldOff);
-    if (f.read((uint8_t*)&v,4) != 4) break;
+    if (!_readAt(f, fieldOff, (uint8_t*)&v, 4)) break;
     if (fabs(v - val) < 1e-6f) { f.close(); return pos; }
     pos += _recordSize;
   }
@@ -496,16 +1125,14 @@ size_t NanoTable::_findOffsetByColFloat(const String &col, float val) {
 }
 
 bool NanoTable::read(int32_t idValue, NanoRecord &outRec) {
+  NANO_OP_SCOPE(NANO_OP_READ);
   size_t off = _findOffsetById(idValue);
   if (off == SIZE_MAX) return false;
-  File f = NANOFS.open(_path,"r");
-  if (!f) return false;
-  bool ok = _readRecordAt(f, off, outRec);
-  f.close();
-  return ok;
+  return _loadAt(off, outRec);
 }
 
 bool NanoTable::update(NanoRecord &rec) {
+  NANO_OP_SCOPE(NANO_OP_UPDATE);
   if (_colCount==0 && !_loadHeader()) return false;
   // require id
   int idIdx = -1;
@@ -515,43 +1142,40 @@ bool NanoTable::update(NanoRecord &rec) {
   if (idv == 0) return false;
   size_t off = _findOffsetById(idv);
   if (off == SIZE_MAX) return false;
-  File f = NANOFS.open(_path,"r+");
+  if (!rec.dirtyMask()) return true; // nothing changed since it was read/saved
+  File f = _open(_path, "r+");
   if (!f) return false;
-  bool ok = _writeRecordAt(f, off, rec);
+  bool ok = _writeDirtyAt(f, off, rec);
   f.close();
+  if (ok) rec.markClean();
   return ok;
 }
 
-bool NanoTable::find(NanoRecord &outRec, int32_t idValue) { return read(idValue, outRec); }
+bool NanoTable::find(NanoRecord &outRec, int32_t idValue) {
+  NANO_OP_SCOPE(NANO_OP_FIND);
+  return read(idValue, outRec);
+}
 bool NanoTable::find(NanoRecord &outRec, const String &col, const String &val) {
+  NANO_OP_SCOPE(NANO_OP_FIND);
   size_t off = _findOffsetByColString(col, val);
   if (off == SIZE_MAX) return false;
-  File f = NANOFS.open(_path,"r");
-  if (!f) return false;
-  bool ok = _readRecordAt(f, off, outRec);
-  f.close();
-  return ok;
+  return _loadAt(off, outRec);
 }
 bool NanoTable::find(NanoRecord &outRec, const String &col, int32_t val) {
+  NANO_OP_SCOPE(NANO_OP_FIND);
   size_t off = _findOffsetByColInt(col, val);
   if (off == SIZE_MAX) return false;
-  File f = NANOFS.open(_path,"r");
-  if (!f) return false;
-  bool ok = _readRecordAt(f, off, outRec);
-  f.close();
-  return ok;
+  return _loadAt(off, outRec);
 }
 bool NanoTable::find(NanoRecord &outRec, const String &col, float val) {
+  NANO_OP_SCOPE(NANO_OP_FIND);
   size_t off = _findOffsetByColFloat(col, val);
   if (off == SIZE_MAX) return false;
-  File f = NANOFS.open(_path,"r");
-  if (!f) return false;
-  bool ok = _readRecordAt(f, off, outRec);
-  f.close();
-  return ok;
+  return _loadAt(off, outRec);
 }
 
 bool NanoTable::findNext(NanoRecord &rec, int32_t id) {
+    NANO_OP_SCOPE(NANO_OP_FIND);
     int32_t nextId = id + 1;
     int32_t total = lastId();
     while (nextId <= total) {
@@ -561,6 +1185,7 @@ bool NanoTable::findNext(NanoRecord &rec, int32_t id) {
     return false;
 }
 bool NanoTable::findPrevious(NanoRecord &rec, int32_t id) {
+    NANO_OP_SCOPE(NANO_OP_FIND);
     int32_t prevId = id - 1;
     while (prevId > 0) {
         if (find(rec, prevId)) return true;
@@ -569,7 +1194,33 @@ bool NanoTable::findPrevious(NanoRecord &rec, int32_t id) {
     return false;
 }
 
+bool NanoTable::view(NanoRecord &outRec, int32_t idValue) {
+  NANO_OP_SCOPE(NANO_OP_FIND);
+  size_t off = _findOffsetById(idValue);
+  if (off == SIZE_MAX) return false;
+  return _viewAt(off, outRec);
+}
+bool NanoTable::view(NanoRecord &outRec, const String &col, const String &val) {
+  NANO_OP_SCOPE(NANO_OP_FIND);
+  size_t off = _findOffsetByColString(col, val);
+  if (off == SIZE_MAX) return false;
+  return _viewAt(off, outRec);
+}
+bool NanoTable::view(NanoRecord &outRec, const String &col, int32_t val) {
+  NANO_OP_SCOPE(NANO_OP_FIND);
+  size_t off = _findOffsetByColInt(col, val);
+  if (off == SIZE_MAX) return false;
+  return _viewAt(off, outRec);
+}
+bool NanoTable::view(NanoRecord &outRec, const String &col, float val) {
+  NANO_OP_SCOPE(NANO_OP_FIND);
+  size_t off = _findOffsetByColFloat(col, val);
+  if (off == SIZE_MAX) return false;
+  return _viewAt(off, outRec);
+}
+
 bool NanoTable::drop(int32_t idValue) {
+  NANO_OP_SCOPE(NANO_OP_DROP);
   // logical delete: set id to zero
   size_t off = _findOffsetById(idValue);
   if (off == SIZE_MAX) return false;
@@ -577,13 +1228,13 @@ bool NanoTable::drop(int32_t idValue) {
   int idIdx = -1;
   for (int i=0;i<_colCount;i++) if (_cols[i].name=="id" && _cols[i].type=='I') { idIdx=i; break; }
   if (idIdx < 0) return false;
-  File f = NANOFS.open(_path,"r+");
+  File f = _open(_path, "r+");
   if (!f) return false;
   size_t idOff = off;
   for (int j=0;j<idIdx;j++) idOff += _typeSize(_cols[j]);
-  f.seek(idOff);
+  _seek(f, idOff);
   int32_t zero = 0;
-  f.write((const uint8_t*)&zero,4);
+  _write(f, (const uint8_t*)&zero,4);
   f.close();
   return true;
 }
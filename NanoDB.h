@@ -11,9 +11,109 @@
   #error "NanoDB: LittleFS or SPIFFS required"
 #endif
 
-#define NANO_MAX_COLS 16
+#define NANO_MAX_COLS 16 // also the width of NanoRecord's dirty-column mask
 #define NANO_MAX_STR_LEN 128
 
+// Streaming export/import (NanoTable::exportTo / importFrom). Rows move in
+// checksummed chunks of at most this many bytes (at least one row), which
+// also bounds the RAM used on both sides. Exporter and importer must agree.
+#ifndef NANO_IO_CHUNK
+#define NANO_IO_CHUNK 512
+#endif
+
+enum NanoFormat : uint8_t {
+  NANO_FMT_BINARY = 0, // "NDB1", schema, chunks of {uint16 rows, row bytes, uint32 crc32}, uint16 0
+  NANO_FMT_CSV         // header line of column names, one line per row (export only)
+};
+
+// orderBy(): RAM budget for sort buffers (NanoTable::setSortMemory overrides it
+// per table) and how many spilled runs are merged at once.
+#ifndef NANO_SORT_MEM
+#define NANO_SORT_MEM 2048
+#endif
+#ifndef NANO_SORT_FANIN
+#define NANO_SORT_FANIN 4
+#endif
+
+// Per-table I/O and latency instrumentation. Off by default; build with
+// -DNANODB_STATS=1 to enable. When off, every hook compiles to nothing.
+#ifndef NANODB_STATS
+#define NANODB_STATS 0
+#endif
+
+// Read-only memory mapping of table files (NanoTable::map). Needs POSIX mmap
+// and the host directory that backs NANOFS, e.g. -DNANODB_MMAP_ROOT="\"/tmp/fs\"".
+// Not available on ESP32: LittleFS/SPIFFS files are not contiguous in flash,
+// so map() returns false there and every call keeps using the File API.
+#if defined(NANODB_MMAP_ROOT) && __has_include(<sys/mman.h>)
+  #define NANODB_HAS_MMAP 1
+#else
+  #define NANODB_HAS_MMAP 0
+#endif
+
+#define NANO_LAT_BUCKETS 20 // latency histogram: bucket i counts calls taking [2^i, 2^(i+1)) us
+
+enum NanoOp : uint8_t {
+  NANO_OP_READ = 0,
+  NANO_OP_SAVE,
+  NANO_OP_UPDATE,
+  NANO_OP_FIND,
+  NANO_OP_DROP,
+  NANO_OP_OTHER,  // begin/records/lastId/size and anything not listed above
+  NANO_OP_COUNT
+};
+#define NANO_OP_TIMED 4 // read/save/update/find get latency histograms
+
+struct NanoIoStats {
+  uint32_t opens;
+  uint32_t seeks;
+  uint32_t reads;
+  uint32_t writes;
+  uint32_t bytesRead;
+  uint32_t bytesWritten;
+};
+
+struct NanoStats {
+  NanoIoStats io[NANO_OP_COUNT];
+  uint32_t scans;        // table scans started
+  uint32_t rowsExamined; // rows visited by all scans
+  uint32_t lastScanRows; // rows visited by the most recent scan
+  uint32_t recordAllocs; // NanoRecord::attach calls (heap allocations) made by the table
+  uint32_t latency[NANO_OP_TIMED][NANO_LAT_BUCKETS];
+};
+
+#if NANODB_STATS
+// RAII helpers used by NanoTable: the outermost public call owns the op
+// (so find() -> read() counts as one find) and records its latency.
+class NanoOpScope {
+public:
+  NanoOpScope(NanoStats &stats, uint8_t &curOp, uint8_t op);
+  ~NanoOpScope();
+private:
+  NanoStats &_stats;
+  uint8_t &_curOp;
+  bool _outer;
+  uint32_t _start;
+};
+
+class NanoScanScope {
+public:
+  NanoScanScope(NanoStats &stats) : _stats(stats), _start(stats.rowsExamined) { _stats.scans++; }
+  ~NanoScanScope() { _stats.lastScanRows = _stats.rowsExamined - _start; }
+private:
+  NanoStats &_stats;
+  uint32_t _start;
+};
+
+  #define NANO_OP_SCOPE(op) NanoOpScope _nanoOpScope(_stats, _statOp, op)
+  #define NANO_SCAN_SCOPE() NanoScanScope _nanoScanScope(_stats)
+  #define NANO_STAT(stmt) do { stmt; } while (0)
+#else
+  #define NANO_OP_SCOPE(op) do {} while (0)
+  #define NANO_SCAN_SCOPE() do {} while (0)
+  #define NANO_STAT(stmt) do {} while (0)
+#endif
+
 struct ColumnDef {
   String name;   // column name
   char type;     // 'I','F','S','B'
@@ -27,6 +127,8 @@ public:
 
   // attach/detach to a table schema (called by NanoTable::newRecord)
   void attach(const ColumnDef *cols, uint8_t colCount, uint16_t rowSize);
+  // attach as a read-only view onto an existing row (called by NanoTable::view)
+  void attachView(const ColumnDef *cols, uint8_t colCount, uint16_t rowSize, const uint8_t *row);
   void detach(); // free internal buffer
 
   // Field proxy for rec["col"] = val and conversions
@@ -85,20 +187,63 @@ public:
   const uint8_t* rawData() const { return _data; }
   uint8_t* rawData() { return _data; }
   uint16_t rowSize() const { return _rowSize; }
+  bool isView() const { return _view; } // non-owning and read-only
+
+  // change tracking: setters mark their column dirty; NanoTable clears the
+  // mask after read/save/update, and update() writes only dirty columns
+  uint16_t dirtyMask() const { return _dirty; } // bit i = column i
+  bool isDirty(uint8_t idx) const { return idx < _colCount && (_dirty & (1u << idx)); }
+  void markClean() { _dirty = 0; }
+  void markDirty() { _dirty = (uint16_t)((1ul << _colCount) - 1); } // force a full-row update
 
 private:
   const ColumnDef* _cols;
   uint8_t _colCount;
   uint16_t _rowSize;
   uint8_t* _data; // raw row buffer
+  bool _view;     // _data points into a table mapping, not owned
+  uint16_t _dirty; // columns modified since the last read/save/update
 
   int colIndexByName(const String &name) const;
   size_t offsetOf(uint8_t idx) const;
 };
 
+class NanoTable;
+struct NanoSortKey; // sort order for orderBy(), defined in NanoDB.cpp
+
+// Streams the result of NanoTable::orderBy() one row at a time. Holds sorted
+// (key, row offset) entries in RAM or in a temp file on NANOFS; rows are read
+// from the table on demand. Invalid once the table is written to.
+class NanoCursor {
+public:
+  NanoCursor();
+  ~NanoCursor();
+
+  bool next(NanoRecord &outRec); // false when exhausted
+  void close();                  // release buffers, files and the temp run
+  uint32_t remaining() const { return _left; }
+
+private:
+  friend class NanoTable;
+  NanoTable *_table;
+  File _data;        // table file (unused while the table is mapped)
+  File _run;         // final sorted run when the sort spilled
+  String _runPath;
+  uint8_t *_buf;     // sorted entries when everything fit in RAM
+  uint32_t _count;
+  uint32_t _pos;
+  uint32_t _left;    // rows still to return (limit)
+  uint16_t _entrySize;
+  uint16_t _keySize;
+
+  NanoCursor(const NanoCursor&) = delete;
+  NanoCursor& operator=(const NanoCursor&) = delete;
+};
+
 class NanoTable {
 public:
   NanoTable(const String &tableName);
+  ~NanoTable();
 
   // FS must be begun by user (LittleFS.begin() / SPIFFS.begin())
   // begin: create or load header
@@ -120,7 +265,7 @@ public:
 
   // read/update/find/delete
   bool read(int32_t idValue, NanoRecord &outRec);            // fill outRec with record having id==idValue
-  bool update(NanoRecord &rec);                              // update record by rec["id"]
+  bool update(NanoRecord &rec);                              // update changed fields of record rec["id"]
   bool find(NanoRecord &outRec, int32_t idValue);            // alias to read
   bool find(NanoRecord &outRec, const String &col, const String &val);
   bool find(NanoRecord &outRec, const String &col, int32_t val);
@@ -132,6 +277,44 @@ public:
   // delete record by id (logical delete: id -> 0)
   bool drop(int32_t idValue);
 
+  // sorted listing: ascending/descending by col, at most limit rows (0 = all).
+  // A limit that fits the sort budget runs as a single-scan top-K heap; anything
+  // else is an external merge sort spilling runs to temp files on NANOFS.
+  bool orderBy(NanoCursor &cur, const String &col, bool asc = true, uint32_t limit = 0);
+  void setSortMemory(size_t bytes) { _sortMem = bytes; }
+
+  // streaming backup/provisioning
+  // returns the live rows the output fully accepted; a short write stops the export
+  // (binary: 0 if even the end-of-dump marker could not be written)
+  uint32_t exportTo(Print &out, NanoFormat fmt = NANO_FMT_BINARY);
+  // append rows from a binary export; the schema must match. Returns the rows
+  // appended. Chunks are verified before they are written, so a bad chunk stops
+  // the import with the rows before it kept: retry with skip = rows imported so
+  // far to resume from the same dump without duplicates. Imported ids are kept
+  // while they increase past the table's highest id, otherwise the row gets the
+  // next free id.
+  uint32_t importFrom(Stream &in, uint32_t skip = 0);
+
+  // read-only memory mapping (host builds with NANODB_MMAP_ROOT, see above)
+  // while mapped, scans and lookups read rows in place instead of via File
+  bool map();   // false if unsupported or the file can't be mapped
+  void unmap();
+  bool mapped() const { return _map != nullptr; }
+
+  // zero-copy lookups: while mapped, outRec becomes a read-only view onto the
+  // row (valid until the next save()/drop()/unmap()); otherwise same as find()
+  bool view(NanoRecord &outRec, int32_t idValue);
+  bool view(NanoRecord &outRec, const String &col, const String &val);
+  bool view(NanoRecord &outRec, const String &col, int32_t val);
+  bool view(NanoRecord &outRec, const String &col, float val);
+
+#if NANODB_STATS
+  // instrumentation (only with NANODB_STATS=1)
+  const NanoStats& stats() const { return _stats; }
+  void resetStats();
+  void dumpStats(Print &out) const; // compact one-line-per-section text dump
+#endif
+
 private:
   String _name;
   String _path;
@@ -140,6 +323,28 @@ private:
   uint8_t _colCount;
   uint16_t _recordSize; // bytes per record
 
+  const uint8_t* _map; // read-only file mapping, nullptr when not mapped
+  size_t _mapLen;
+  size_t _sortMem;     // orderBy() buffer budget in bytes
+  uint32_t _sortSeq;   // numbers orderBy() calls for unique temp run names
+
+#if NANODB_STATS
+  NanoStats _stats;
+  uint8_t _statOp; // op owning the current I/O, NANO_OP_OTHER when idle
+#endif
+
+  // file I/O wrappers (counted when NANODB_STATS=1, plain pass-through otherwise)
+  File _open(const String &path, const char *mode);
+  bool _seek(File &f, size_t offset);
+  size_t _read(File &f, uint8_t *buf, size_t len);
+  size_t _write(File &f, const uint8_t *buf, size_t len);
+
+  // scan/lookup helpers: served from the mapping when mapped, from f otherwise
+  bool _openScan(File &f);
+  size_t _scanEnd(File &f);
+  const uint8_t* _fetch(File &f, size_t offset, uint8_t *buf, size_t len); // in place or via buf
+  bool _readAt(File &f, size_t offset, uint8_t *dst, size_t len);
+
   bool _exists() const;
   bool _writeHeader(const ColumnDef *cols, uint8_t colCount);
   bool _loadHeader();
@@ -150,6 +355,9 @@ private:
   // file record helpers
   bool _readRecordAt(File &f, size_t offset, NanoRecord &outRec);
   bool _writeRecordAt(File &f, size_t offset, const NanoRecord &rec);
+  bool _writeDirtyAt(File &f, size_t offset, const NanoRecord &rec);
+  bool _loadAt(size_t offset, NanoRecord &outRec);
+  bool _viewAt(size_t offset, NanoRecord &outRec);
 
   // find offsets
   size_t _findOffsetById(int32_t idValue);
@@ -159,6 +367,13 @@ private:
 
   int32_t _nextId();
 
+  // orderBy helpers
+  String _runPath(uint32_t sort, uint32_t run) const;
+  bool _spillRun(uint8_t *entries, uint32_t n, uint16_t entrySize, uint32_t sort, uint32_t run);
+  bool _mergeRuns(uint32_t sort, uint32_t first, uint32_t count, uint32_t out, uint16_t entrySize, const NanoSortKey &key);
+
+  friend class NanoCursor;
+
   // no copy
   NanoTable(const NanoTable&) = delete;
   NanoTable& operator=(const NanoTable&) = delete;
@@ -12,6 +12,143 @@ ColumnDef cols[] = {
 
 NanoTable users("users");
 
+uint32_t failures = 0;
+
+void check(bool ok, const char *what) {
+  Serial.println(String(ok ? "  ok   " : "  FAIL ") + what);
+  if (!ok) failures++;
+}
+
+// fresh table with `count` rows: name "User<i>", age 20 + i % 30, rating i % 5 + 0.5
+void fill(NanoTable &t, uint32_t count) {
+  t.drop();
+  t.begin(cols, 5);
+  for (uint32_t i=0;i<count;i++) {
+    NanoRecord r;
+    t.newRecord(r);
+    r["name"] = "User" + String(i);
+    r["age"] = (int32_t)(20 + (i % 30));
+    r["rating"] = (float)(i % 5) + 0.5;
+    r["active"] = (i % 2) == 0;
+    t.save(r);
+  }
+}
+
+#if NANODB_STATS
+// collects dumpStats() output
+class StringPrint : public Print {
+public:
+  String text;
+  size_t write(uint8_t c) override { text += (char)c; return 1; }
+};
+
+bool statsZero(const NanoStats &st) {
+  for (int i=0;i<NANO_OP_COUNT;i++) {
+    const NanoIoStats &io = st.io[i];
+    if (io.opens || io.seeks || io.reads || io.writes || io.bytesRead || io.bytesWritten) return false;
+  }
+  if (st.scans || st.rowsExamined || st.lastScanRows || st.recordAllocs) return false;
+  for (int i=0;i<NANO_OP_TIMED;i++)
+    for (int b=0;b<NANO_LAT_BUCKETS;b++) if (st.latency[i][b]) return false;
+  return true;
+}
+
+bool ioZero(const NanoIoStats &io) {
+  return !io.opens && !io.seeks && !io.reads && !io.writes && !io.bytesRead && !io.bytesWritten;
+}
+
+uint32_t latencyCount(const NanoStats &st, uint8_t op) {
+  uint32_t n = 0;
+  for (int b=0;b<NANO_LAT_BUCKETS;b++) n += st.latency[op][b];
+  return n;
+}
+#endif
+
+void testStats() {
+  Serial.println("------- stats -------");
+#if NANODB_STATS
+  NanoTable t("statstest");
+  fill(t, 30);
+  NanoRecord r;
+  t.find(r, 5);
+  check(!statsZero(t.stats()), "counters move");
+  t.resetStats();
+  check(statsZero(t.stats()), "resetStats() zeroes all counters");
+
+  // find by column: one scan that stops at the matching row (User11 is row 12)
+  NanoRecord got;
+  check(t.find(got, "name", "User11"), "find by name");
+  const NanoStats &st = t.stats();
+  check(st.scans == 1 && st.lastScanRows == 12 && st.rowsExamined == 12, "lastScanRows is the matching row's position");
+  check(st.io[NANO_OP_FIND].opens > 0 && st.io[NANO_OP_FIND].bytesRead > 0, "find I/O counted under find");
+  check(ioZero(st.io[NANO_OP_READ]) && ioZero(st.io[NANO_OP_OTHER]), "nothing counted under read/other");
+  check(st.recordAllocs == 1, "one record allocation");
+  check(latencyCount(st, NANO_OP_FIND) == 1, "one find latency sample");
+
+  // find by id goes through read(), but is accounted once, to find
+  t.resetStats();
+  check(t.find(got, 20) && (int32_t)got["id"] == 20, "find by id");
+  check(latencyCount(st, NANO_OP_FIND) == 1 && latencyCount(st, NANO_OP_READ) == 0, "find by id timed once, as find");
+  check(st.io[NANO_OP_FIND].opens > 0 && ioZero(st.io[NANO_OP_READ]), "find by id I/O counted under find only");
+
+  StringPrint dump;
+  t.dumpStats(dump);
+  Serial.print(dump.text);
+  String text = dump.text;
+  int io = text.indexOf("io find o=");
+  int scan = text.indexOf("scan n=1 rows=20 last=20 alloc=0");
+  int lat = text.indexOf("lat find ");
+  check(io >= 0 && text.indexOf(" s=", io) > io && text.indexOf(" rb=", io) > io && text.indexOf(" wb=", io) > io, "dump has the io find line");
+  check(scan >= 0, "dump has the scan line");
+  check(lat >= 0 && text.indexOf(':', lat) > lat, "dump has the lat find line");
+  check(text.indexOf("io read") < 0 && text.indexOf("lat read") < 0, "dump has no read lines");
+  t.drop();
+#else
+  Serial.println("skipped (build with NANODB_STATS=1)");
+#endif
+}
+
+void testView() {
+  Serial.println("------- map() / view() -------");
+  NanoTable t("viewtest");
+  fill(t, 20);
+  bool mapped = t.map(); // false on ESP32: view() then copies like find()
+  Serial.println(String("mapped: ") + (mapped ? "yes" : "no"));
+
+  NanoRecord v;
+  check(t.view(v, "name", "User7"), "view by name");
+  check((int32_t)v["id"] == 8 && (int32_t)v["age"] == 27, "view reads fields");
+  check(v.isView() == mapped, "view is zero-copy only when mapped");
+  check(t.view(v, 3) && String(v["name"]) == "User2", "view by id");
+  check(!t.view(v, "name", "nobody"), "view misses unknown value");
+
+  NanoRecord c;
+  check(t.find(c, "age", (int32_t)25) && !c.isView(), "find returns an owned copy while mapped");
+  c["age"] = (int32_t)99;
+  check(t.update(c), "update while mapped");
+  check(t.view(v, "age", (int32_t)99) && (int32_t)v["id"] == (int32_t)c["id"], "mapped scan sees the update");
+
+  NanoRecord r;
+  t.newRecord(r);
+  r["name"] = "Late";
+  t.save(r);
+  check(t.view(v, "name", "Late") && (int32_t)v["id"] == 21, "view sees rows appended after map()");
+  t.unmap();
+
+  // a record last used with a table of smaller rows must be re-attached, not overrun
+  ColumnDef tinyCols[] = { {"id",'I',4} };
+  NanoTable tiny("viewtiny");
+  tiny.drop();
+  tiny.begin(tinyCols, 1);
+  NanoRecord shared;
+  tiny.newRecord(shared);
+  tiny.save(shared);
+  check(tiny.read(1, shared) && shared.rowSize() == 4, "read from small table");
+  check(t.read(5, shared) && String(shared["name"]) == "User4", "same record reused on a wider table");
+  tiny.drop();
+  t.drop();
+}
+
 void test(uint32_t records = 100) {
   Serial.println("------- Testing NanoDB -------");
   Serial.println("creating record...");
@@ -86,7 +223,7 @@ void test(uint32_t records = 100) {
     NanoRecord r;
     users.newRecord(r);
     r["name"] = "User" + String(i);
-    r["age"] = 20 + (i % 30);
+    r["age"] = (int32_t)(20 + (i % 30));
     r["rating"] = (float)(i % 5) + 0.5;
     r["active"] = (i % 2) == 0;
     users.save(r);
@@ -96,7 +233,7 @@ void test(uint32_t records = 100) {
   Serial.println(String("total records now: ") + users.records());
 
   Serial.println("searching records...");
-  if (recods > 5) {
+  if (records > 5) {
     Serial.println("searching for record id=5...");
     start = millis();
     NanoRecord r;
@@ -104,7 +241,7 @@ void test(uint32_t records = 100) {
     Serial.println(String("found record id=5: name=") + (const char*)r["name"] + String(", age=") + (int)r["age"] + " in " + (millis() - start) + " ms");
   }
 
-  if (recods > 10) {
+  if (records > 10) {
     Serial.println(String("searching for record id=") + (records - 1) + "...");
     start = millis();
     NanoRecord r;
@@ -113,14 +250,14 @@ void test(uint32_t records = 100) {
   }
 
   Serial.println("deleting records...");
-  if (recods > 5) {
+  if (records > 5) {
     Serial.println("deleting record with id=5...");
     start = millis();
     users.drop(5);
     Serial.println(String("deleted record with id=5 in ") + (millis() - start) + " ms");
   }
 
-  if (recods > 10) {
+  if (records > 10) {
     Serial.println(String("deleting record with id=") + (records - 1) + "...");
     start = millis();
     users.drop(records - 1);
@@ -130,6 +267,194 @@ void test(uint32_t records = 100) {
   Serial.println("------- Stress test complete -------");
 }
 
+void testDirtyUpdate() {
+  Serial.println("------- dirty-field update() -------");
+  NanoTable t("dirtytest");
+  fill(t, 10);
+
+  NanoRecord r;
+  check(t.read(4, r) && r.dirtyMask() == 0, "fresh read is clean");
+  r["active"] = true;
+  check(r.isDirty(3) && !r.isDirty(1), "setter marks only its column");
+#if NANODB_STATS
+  t.resetStats();
+#endif
+  check(t.update(r) && r.dirtyMask() == 0, "update clears the mask");
+#if NANODB_STATS
+  check(t.stats().io[NANO_OP_UPDATE].writes == 1 && t.stats().io[NANO_OP_UPDATE].bytesWritten == 1,
+        "flag toggle is a single 1-byte write");
+#endif
+  NanoRecord got;
+  check(t.read(4, got) && (bool)got["active"] && String(got["name"]) == "User3", "flag persisted, rest intact");
+
+  check(t.update(r), "update with nothing changed");
+
+  // only the fields that were set are written; the others keep their stored values
+  NanoRecord partial;
+  t.newRecord(partial);
+  partial["id"] = (int32_t)6;
+  partial["age"] = (int32_t)77;
+  check(t.update(partial), "partial update by id");
+  check(t.read(6, got) && (int32_t)got["age"] == 77 && String(got["name"]) == "User5", "partial update keeps other fields");
+
+  // markDirty() forces a full-row rewrite
+  partial["name"] = "Blank";
+  partial.markDirty();
+  check(t.update(partial), "forced full-row update");
+  check(t.read(6, got) && (float)got["rating"] == 0.0f && String(got["name"]) == "Blank", "full row rewritten");
+  t.drop();
+}
+
+// drains cur; true if rows arrive ordered by col (ties in id order) and there are `expect` of them
+bool sortedBy(NanoCursor &cur, const char *col, bool isFloat, bool asc, uint32_t expect) {
+  NanoRecord r;
+  uint32_t n = 0;
+  float prevKey = 0;
+  int32_t prevId = 0;
+  bool ok = true;
+  while (cur.next(r)) {
+    float key = isFloat ? (float)r[col] : (float)(int32_t)r[col];
+    int32_t id = r["id"];
+    if (n > 0) {
+      if (asc ? key < prevKey : key > prevKey) ok = false;
+      if (key == prevKey && id <= prevId) ok = false;
+    }
+    prevKey = key;
+    prevId = id;
+    n++;
+  }
+  cur.close();
+  return ok && n == expect;
+}
+
+void testSort() {
+  Serial.println("------- orderBy() -------");
+  NanoTable t("sorttest");
+  fill(t, 200);
+  t.drop(5);
+  t.drop(77);
+  t.drop(150);
+
+  NanoCursor cur;
+  check(t.orderBy(cur, "rating", true), "in-memory sort");
+  check(sortedBy(cur, "rating", true, true, 197), "ascending, deleted rows skipped");
+
+  // top-K: the 20 highest ratings are the rows with i % 5 == 4, in id order
+  check(t.orderBy(cur, "rating", false, 20), "top-K");
+  NanoRecord r;
+  check(cur.next(r) && (float)r["rating"] == 4.5f && (int32_t)r["id"] == 10, "top-K first row (id 5 deleted)");
+  check(cur.remaining() == 19, "top-K remaining");
+  cur.close();
+  check(t.orderBy(cur, "rating", false, 20) && sortedBy(cur, "rating", true, false, 20), "top-K order");
+
+  // 64 bytes = 8 entries per run: spills ~25 runs and merges them over several passes
+  t.setSortMemory(64);
+  check(t.orderBy(cur, "age", true), "external sort");
+  check(sortedBy(cur, "age", false, true, 197), "external sort order");
+  check(t.orderBy(cur, "rating", false, 50), "external sort with limit");
+  check(sortedBy(cur, "rating", true, false, 50), "limit beyond the sort budget");
+
+  // two spilled cursors on one table must not share temp files
+  NanoCursor a, b;
+  check(t.orderBy(a, "rating", false) && t.orderBy(b, "age", true), "two cursors open");
+  check(sortedBy(a, "rating", true, false, 197), "first cursor unaffected by the second");
+  check(sortedBy(b, "age", false, true, 197), "second cursor");
+
+  check(!t.orderBy(cur, "nocolumn"), "unknown column rejected");
+  t.setSortMemory(NANO_SORT_MEM);
+  t.drop();
+}
+
+void testBackup() {
+  Serial.println("------- exportTo() / importFrom() -------");
+  NanoTable src("bksrc");
+  NanoTable dst("bkdst");
+  fill(src, 100);
+  src.drop(10);
+  src.drop(50);
+
+  File out = LittleFS.open("/backup.ndb", "w");
+  uint32_t exported = src.exportTo(out);
+  out.close();
+  check(exported == 98, "binary export skips deleted rows");
+
+  dst.drop();
+  dst.begin(cols, 5);
+  File in = LittleFS.open("/backup.ndb", "r");
+  check(dst.importFrom(in) == 98, "import binary dump");
+  in.close();
+  check(dst.records() == 98, "all rows imported");
+  check(dst.lastId() == 100, "ids preserved");
+  NanoRecord r;
+  check(dst.find(r, 51) && String(r["name"]) == "User50" && (int32_t)r["age"] == 40, "row contents preserved");
+  check(!dst.find(r, 10), "deleted row not imported");
+
+  in = LittleFS.open("/backup.ndb", "r");
+  check(dst.importFrom(in) == 98, "import into non-empty table");
+  in.close();
+  check(dst.records() == 196 && dst.lastId() == 198, "colliding ids get next free id");
+
+  // flip one byte in the last chunk: earlier chunks import, the bad one is rejected
+  File bad = LittleFS.open("/backup.ndb", "r+");
+  size_t badPos = bad.size() - 10; // before crc (4) + terminator (2)
+  bad.seek(badPos);
+  uint8_t b = bad.read();
+  bad.seek(badPos);
+  b ^= 0x55;
+  bad.write(&b, 1);
+  bad.close();
+  dst.drop();
+  dst.begin(cols, 5);
+  in = LittleFS.open("/backup.ndb", "r");
+  uint32_t imported = dst.importFrom(in);
+  in.close();
+  check(imported > 0 && imported < 98, "corrupt chunk stops the import");
+  check(dst.records() == imported, "returned count matches rows kept");
+
+  // repair the byte and resume: the rows already imported are skipped, not duplicated
+  bad = LittleFS.open("/backup.ndb", "r+");
+  bad.seek(badPos);
+  b ^= 0x55;
+  bad.write(&b, 1);
+  bad.close();
+  in = LittleFS.open("/backup.ndb", "r");
+  check(dst.importFrom(in, imported) == 98 - imported, "resume imports the rest");
+  in.close();
+  check(dst.records() == 98 && dst.lastId() == 100, "resumed import has no duplicates");
+
+  // schema mismatch
+  ColumnDef otherCols[] = { {"id",'I',4}, {"name",'S',10} };
+  NanoTable other("bkother");
+  other.drop();
+  other.begin(otherCols, 2);
+  out = LittleFS.open("/backup.ndb", "w");
+  src.exportTo(out);
+  out.close();
+  in = LittleFS.open("/backup.ndb", "r");
+  check(other.importFrom(in) == 0 && other.records() == 0, "import into different schema rejected");
+  in.close();
+
+  // CSV: header + one line per live row
+  out = LittleFS.open("/backup.csv", "w");
+  check(src.exportTo(out, NANO_FMT_CSV) == 98, "csv export");
+  out.close();
+  in = LittleFS.open("/backup.csv", "r");
+  String header = in.readStringUntil('\n');
+  String first = in.readStringUntil('\n');
+  uint32_t lines = 2;
+  while (in.available()) { in.readStringUntil('\n'); lines++; }
+  in.close();
+  check(header.startsWith("id,name,age,active,rating"), "csv header");
+  check(first.startsWith("1,\"User0\",20,1,0.5"), "csv row");
+  check(lines == 99, "csv line count");
+
+  LittleFS.remove("/backup.ndb");
+  LittleFS.remove("/backup.csv");
+  other.drop();
+  src.drop();
+  dst.drop();
+}
+
 void setup(){
   Serial.begin(115200);
   delay(1000);
@@ -152,6 +477,14 @@ void setup(){
   }
 
   test(1000);                    // проводить стрес-тест з 1000 записів (~110 секунд на ESP32)
+
+  testStats();
+  testView();
+  testDirtyUpdate();
+  testBackup();
+  testSort();
+
+  Serial.println(String("------- ") + failures + " check(s) failed -------");
 }
 
 void loop(){